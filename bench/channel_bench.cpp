@@ -0,0 +1,135 @@
+// Three stage pipeline (produce -> transform -> consume) moving ints through
+// bounded queues: ktx::channel with coroutines on a single thread against a
+// thread per stage handing work over ktx::deque + mutex + condition variable.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "ktxchannel.h"
+#include "task.h"
+
+
+namespace {
+
+
+
+constexpr int items = 2'000'000;
+constexpr std::size_t capacity = 64;
+
+long long coroutineSum = 0;
+long long threadSum = 0;
+
+task produce(ktx::channel<int>& out) {
+    for (int i = 0; i < items; ++i) {
+        co_await out.push(i);
+    }
+    out.close();
+}
+
+task transform(ktx::channel<int>& in, ktx::channel<int>& out) {
+    while (auto v = co_await in.pop()) {
+        co_await out.push(*v * 2);
+    }
+    out.close();
+}
+
+task consume(ktx::channel<int>& in) {
+    for (;;) {
+        auto batch = co_await in.pop_n(capacity);
+        if (batch.empty()) {
+            break;
+        }
+        for (int v: batch) {
+            coroutineSum += v;
+        }
+    }
+}
+
+// bounded blocking queue, the setup channel replaces
+class cv_queue {
+public:
+    void push(int value) {
+        std::unique_lock lock{m_};
+        notFull_.wait(lock, [this] { return buf_.size() < capacity; });
+        buf_.push_back(value);
+        notEmpty_.notify_one();
+    }
+
+    std::optional<int> pop() {
+        std::unique_lock lock{m_};
+        notEmpty_.wait(lock, [this] { return buf_.size() || closed_; });
+        if (!buf_.size()) {
+            return std::nullopt;
+        }
+        int value = buf_[0];
+        buf_.pop_front();
+        notFull_.notify_one();
+        return value;
+    }
+
+    void close() {
+        std::lock_guard lock{m_};
+        closed_ = true;
+        notEmpty_.notify_all();
+    }
+
+private:
+    ktx::deque<int> buf_;
+    bool closed_ = false;
+    std::mutex m_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
+
+template <typename F>
+double nsPerItem(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> spent = std::chrono::steady_clock::now() - start;
+    return spent.count() / items;
+}
+
+
+
+}
+
+int main() {
+    auto coroutines = nsPerItem([] {
+        ktx::channel<int> a{capacity};
+        ktx::channel<int> b{capacity};
+        auto c = consume(b);
+        auto t = transform(a, b);
+        auto p = produce(a);
+    });
+
+    auto threads = nsPerItem([] {
+        cv_queue a;
+        cv_queue b;
+        std::thread p{[&] {
+            for (int i = 0; i < items; ++i) {
+                a.push(i);
+            }
+            a.close();
+        }};
+        std::thread t{[&] {
+            while (auto v = a.pop()) {
+                b.push(*v * 2);
+            }
+            b.close();
+        }};
+        while (auto v = b.pop()) {
+            threadSum += *v;
+        }
+        p.join();
+        t.join();
+    });
+
+    std::printf("%d items through 3 stages, capacity %zu\n", items, capacity);
+    std::printf("  channel + coroutines: %8.1f ns/item\n", coroutines);
+    std::printf("  deque + mutex + cv:   %8.1f ns/item\n", threads);
+    std::printf("  results %s\n", coroutineSum == threadSum ? "match" : "DIFFER");
+    return coroutineSum == threadSum ? 0 : 1;
+}
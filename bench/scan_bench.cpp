@@ -0,0 +1,93 @@
+// Sequential sum over a large deque<int>: plain iteration, segments() and
+// for_each_prefetched with several lookahead distances and line counts,
+// lines=0 is the same loop without any prefetching.
+// The "scattered" layout puts filler allocations between the blocks, so the
+// hardware prefetcher can't follow the block sequence by address.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "ktxdeque.h"
+
+
+namespace {
+
+
+
+constexpr std::size_t elements = 32 * 1024 * 1024;
+constexpr int rounds = 5;
+
+volatile long long sink;
+
+template <typename F>
+double nsPerElement(F f) {
+    double best = 1e300;
+    for (int r = 0; r < rounds; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        sink = f();
+        std::chrono::duration<double, std::nano> spent = std::chrono::steady_clock::now() - start;
+        best = std::min(best, spent.count() / elements);
+    }
+    return best;
+}
+
+void run(const char* layout, const ktx::deque<int>& d) {
+    std::printf("%s layout, %zu ints\n", layout, elements);
+
+    std::printf("  iterator:                %6.3f ns/element\n", nsPerElement([&] {
+        long long sum = 0;
+        for (int x: d) {
+            sum += x;
+        }
+        return sum;
+    }));
+
+    std::printf("  segments():              %6.3f ns/element\n", nsPerElement([&] {
+        long long sum = 0;
+        for (auto segment: d.segments()) {
+            for (int x: segment) {
+                sum += x;
+            }
+        }
+        return sum;
+    }));
+
+    for (std::size_t distance: {1, 2, 4, 8}) {
+        for (std::size_t lines: {0, 1, 2, 8}) {
+            std::printf("  prefetched d=%zu lines=%zu: %6.3f ns/element\n", distance, lines,
+                nsPerElement([&] {
+                    long long sum = 0;
+                    d.for_each_prefetched([&sum](int x) { sum += x; }, distance, lines);
+                    return sum;
+                }));
+        }
+    }
+}
+
+
+
+}
+
+int main() {
+    {
+        ktx::deque<int> d;
+        for (std::size_t i = 0; i < elements; ++i) {
+            d.push_back(static_cast<int>(i));
+        }
+        run("contiguous", d);
+    }
+    {
+        std::mt19937 gen{5};
+        std::vector<std::unique_ptr<char[]>> filler;
+        ktx::deque<int> d;
+        for (std::size_t i = 0; i < elements; ++i) {
+            if (i % 128 == 0) {
+                filler.emplace_back(new char[64 + gen() % 4096]);
+            }
+            d.push_back(static_cast<int>(i));
+        }
+        run("scattered", d);
+    }
+}
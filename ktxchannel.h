@@ -0,0 +1,176 @@
+#pragma once
+
+
+#include <coroutine>
+#include <optional>
+#include <span>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+#include "ktxdeque.h"
+
+namespace ktx {
+
+
+
+// Single-threaded channel for C++20 coroutines, buffered by ktx::deque.
+// A coroutine blocked in push or pop is resumed inline by the operation that
+// unblocks it, so handing work between stages never leaves the thread.
+template <typename T>
+class channel {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static constexpr size_type unbounded = std::numeric_limits<size_type>::max();
+
+    class push_awaiter;
+    class pop_awaiter;
+    class pop_n_awaiter;
+    class batch;
+
+private:
+    deque<value_type> buf_;
+    // elements at the front of buf_ handed out by pop and pop_n, destroyed
+    // once every batch holding them is gone
+    size_type consumed_;
+    // sizes of the handed out batches in order and whether they're released,
+    // the first one has the sequence number firstBatch_
+    deque<std::pair<size_type, bool>> batches_;
+    size_type firstBatch_;
+    size_type capacity_;
+    bool closed_;
+    deque<std::coroutine_handle<>> pushers_;
+    deque<std::coroutine_handle<>> poppers_;
+
+public:
+    explicit channel(size_type capacity = unbounded);
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    // co_await ch.push(v) suspends while the channel is full,
+    // yields false if the channel is closed
+    push_awaiter push(value_type value) { return {*this, std::move(value)}; }
+
+    // co_await ch.pop() suspends while the channel is empty,
+    // yields std::nullopt once the channel is closed and drained
+    pop_awaiter pop() { return pop_awaiter{*this}; }
+
+    // co_await ch.pop_n(n) yields a batch of up to n elements lying in one
+    // block of the buffer. They stay in place until the batch is destroyed,
+    // whatever other coroutines do with the channel meanwhile, but don't count
+    // towards the capacity. The batch must not outlive the channel.
+    pop_n_awaiter pop_n(size_type count) { return {*this, count}; }
+
+    // wakes every waiting coroutine, further pushes fail
+    void close();
+
+    // elements waiting to be popped
+    size_type size() const { return buf_.size() - consumed_; }
+
+    size_type capacity() const { return capacity_; }
+
+    bool closed() const { return closed_; }
+
+    class push_awaiter {
+    public:
+        bool await_ready();
+        bool await_suspend(std::coroutine_handle<> h);
+        bool await_resume();
+
+    private:
+        friend class channel<T>;
+
+        channel& ch_;
+        value_type value_;
+        bool pushed_;
+
+        push_awaiter(channel& ch, value_type value)
+            : ch_{ch}, value_{std::move(value)}, pushed_{false} {}
+    };
+
+    class pop_awaiter {
+    public:
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h) { ch_.poppers_.push_back(h); }
+        std::optional<value_type> await_resume();
+
+    private:
+        friend class channel<T>;
+
+        channel& ch_;
+
+        explicit pop_awaiter(channel& ch) : ch_{ch} {}
+    };
+
+    class pop_n_awaiter {
+    public:
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h) { ch_.poppers_.push_back(h); }
+        batch await_resume();
+
+    private:
+        friend class channel<T>;
+
+        channel& ch_;
+        size_type count_;
+
+        pop_n_awaiter(channel& ch, size_type count) : ch_{ch}, count_{count} {}
+    };
+
+    // elements handed out by pop_n, given back to the channel on destruction
+    class batch {
+    public:
+        using iterator = typename std::span<value_type>::iterator;
+
+        batch() = default;
+
+        batch(batch&& other) noexcept
+            : ch_{std::exchange(other.ch_, nullptr)}
+            , seq_{other.seq_}
+            , values_{std::exchange(other.values_, {})} {}
+
+        batch& operator=(batch&& other) noexcept;
+
+        ~batch() { release(); }
+
+        iterator begin() const { return values_.begin(); }
+
+        iterator end() const { return values_.end(); }
+
+        size_type size() const { return values_.size(); }
+
+        [[nodiscard]] bool empty() const { return values_.empty(); }
+
+        value_type& operator[](size_type index) const { return values_[index]; }
+
+        std::span<value_type> span() const { return values_; }
+
+    private:
+        friend class channel<T>;
+
+        channel* ch_ = nullptr;
+        size_type seq_ = 0;
+        std::span<value_type> values_;
+
+        batch(channel& ch, size_type seq, std::span<value_type> values)
+            : ch_{&ch}, seq_{seq}, values_{values} {}
+
+        void release() noexcept;
+    };
+
+private:
+    size_type take(size_type count);
+
+    void release(size_type seq);
+
+    void wakePushers();
+
+    static void wake(deque<std::coroutine_handle<>>& waiters, size_type count = 1);
+};
+
+
+}
+
+#include "ktxchannel_realization.h" // IWYU pragma: keep
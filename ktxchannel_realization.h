@@ -0,0 +1,181 @@
+#pragma once
+
+#include "ktxchannel.h"
+
+
+namespace ktx {
+
+
+
+// public
+
+template <typename T>
+channel<T>::channel(size_type capacity)
+    : buf_{}
+    , consumed_{0}
+    , batches_{}
+    , firstBatch_{0}
+    , capacity_{capacity}
+    , closed_{false}
+    , pushers_{}
+    , poppers_{} {
+    if (capacity == 0) {
+        throw std::invalid_argument{"Capacity of channel must be positive"};
+    }
+}
+
+template <typename T>
+void channel<T>::close() {
+    closed_ = true;
+    wake(poppers_, poppers_.size());
+    wake(pushers_, pushers_.size());
+}
+
+// push_awaiter
+
+template <typename T>
+bool channel<T>::push_awaiter::await_ready() {
+    return ch_.closed_ || (!ch_.poppers_.size() && ch_.size() < ch_.capacity_);
+}
+
+template <typename T>
+bool channel<T>::push_awaiter::await_suspend(std::coroutine_handle<> h) {
+    if (ch_.poppers_.size()) {
+        // the buffer is empty, hand the value over and let the popper run
+        ch_.buf_.push_back(std::move(value_));
+        pushed_ = true;
+        wake(ch_.poppers_);
+        return false;
+    }
+    ch_.pushers_.push_back(h);
+    return true;
+}
+
+template <typename T>
+bool channel<T>::push_awaiter::await_resume() {
+    if (pushed_) {
+        return true;
+    }
+    if (ch_.closed_) {
+        return false;
+    }
+    ch_.buf_.push_back(std::move(value_));
+    return true;
+}
+
+// pop_awaiter
+
+template <typename T>
+bool channel<T>::pop_awaiter::await_ready() {
+    return ch_.size() || ch_.closed_;
+}
+
+template <typename T>
+auto channel<T>::pop_awaiter::await_resume() -> std::optional<value_type> {
+    if (!ch_.size()) {
+        return std::nullopt;
+    }
+    std::optional<value_type> value{std::move(ch_.buf_[ch_.consumed_])};
+    if (ch_.consumed_) {
+        // the cell has to wait for the batches in front of it
+        ch_.release(ch_.take(1));
+    } else {
+        ch_.buf_.pop_front();
+    }
+    ch_.wakePushers();
+    return value;
+}
+
+// pop_n_awaiter
+
+template <typename T>
+bool channel<T>::pop_n_awaiter::await_ready() {
+    return ch_.size() || ch_.closed_;
+}
+
+template <typename T>
+auto channel<T>::pop_n_awaiter::await_resume() -> batch {
+    if (!ch_.size()) {
+        return {};
+    }
+    // skip the blocks of the batches still held by other consumers
+    auto skip = ch_.consumed_;
+    auto segment = ch_.buf_.segments().begin();
+    for (; skip >= (*segment).size(); ++segment) {
+        skip -= (*segment).size();
+    }
+    auto values = (*segment).subspan(skip);
+    values = values.first(std::min(count_, values.size()));
+
+    batch taken{ch_, ch_.take(values.size()), values};
+    // pushers only append behind the batch, the blocks of a deque don't move
+    ch_.wakePushers();
+    return taken;
+}
+
+// batch
+
+template <typename T>
+auto channel<T>::batch::operator=(batch&& other) noexcept -> batch& {
+    if (this != &other) {
+        release();
+        ch_ = std::exchange(other.ch_, nullptr);
+        seq_ = other.seq_;
+        values_ = std::exchange(other.values_, {});
+    }
+    return *this;
+}
+
+template <typename T>
+void channel<T>::batch::release() noexcept {
+    if (ch_) {
+        std::exchange(ch_, nullptr)->release(seq_);
+        values_ = {};
+    }
+}
+
+// private
+
+// Marks count elements behind the consumed ones as handed out and returns
+// the sequence number of their batch.
+template <typename T>
+auto channel<T>::take(size_type count) -> size_type {
+    batches_.push_back({count, false});
+    consumed_ += count;
+    return firstBatch_ + batches_.size() - 1;
+}
+
+// Batches may be released in any order, their elements are destroyed once
+// every batch in front of them is released too.
+template <typename T>
+void channel<T>::release(size_type seq) {
+    batches_[seq - firstBatch_].second = true;
+    while (batches_.size() && batches_[0].second) {
+        buf_.pop_front(batches_[0].first);
+        consumed_ -= batches_[0].first;
+        batches_.pop_front();
+        ++firstBatch_;
+    }
+}
+
+// A woken pusher may go on pushing before it suspends again, so the room is
+// checked before every wake instead of counting the freed cells up front.
+template <typename T>
+void channel<T>::wakePushers() {
+    while (pushers_.size() && size() < capacity_) {
+        wake(pushers_);
+    }
+}
+
+template <typename T>
+void channel<T>::wake(deque<std::coroutine_handle<>>& waiters, size_type count) {
+    for (; count && waiters.size(); --count) {
+        auto h = waiters[0];
+        waiters.pop_front();
+        h.resume();
+    }
+}
+
+
+
+};
@@ -6,7 +6,10 @@
 #include <iterator>
 #include <iostream>
 #include <concepts>
-#include "../ktxvector/ktxvector.h"
+#include <vector>
+#include <algorithm>
+#include "ktxsegments.h"
+#include "ktxstreaming.h"
 
 namespace ktx {
 
@@ -46,7 +49,7 @@ private:
     // to allocate memory for pointers will use the custom allocator
     using rebinded = typename alloc_traits::template rebind_alloc<pointer>;
 #endif
-    vector<pointer, rebinded> outer_;
+    std::vector<pointer, rebinded> outer_;
     [[no_unique_address]] allocator_type alloc_;
 
     static constexpr auto chunkSize = 512ULL;
@@ -58,68 +61,74 @@ private:
         }
     }();
     static constexpr size_t expansion = 2;
+    static constexpr size_t prefetchDistance = 2;
+    static constexpr size_t prefetchLines = 2;
+    static constexpr size_t blockLines =
+        (BlockSize * sizeof(value_type) + detail::cacheLine - 1) / detail::cacheLine;
 
 public:
     // constructors and assign
-    deque() : ai_{0}, sz_{0}, outer_{}, alloc_{} {}
+    constexpr deque() : ai_{0}, sz_{0}, outer_{}, alloc_{} {}
 
-    deque(std::initializer_list<value_type> list, 
+    constexpr deque(std::initializer_list<value_type> list, 
             Allocator alloc = Allocator());
 
-    explicit deque(Allocator a) 
+    constexpr explicit deque(Allocator a) 
         : ai_{}, sz_{0}, outer_{}, alloc_{a} {}
 
-    explicit deque(size_type n, const T& val = T(), Allocator a = Allocator());
+    constexpr explicit deque(size_type n, const T& val = T(), Allocator a = Allocator());
 
     template<std::forward_iterator Iter>
-    deque(Iter fst, Iter lst);
+    constexpr deque(Iter fst, Iter lst);
 
 
-    deque(const deque& other);
+    constexpr deque(const deque& other);
 
-    deque(deque&& other) noexcept : deque{} { swap(*this, other); }
+    constexpr deque(deque&& other) noexcept : deque{} { swap(*this, other); }
 
-    deque& operator=(deque other) {
+    constexpr deque& operator=(deque other) {
         swap(*this, other);
         return *this;
     }
 
     // dtor
-    ~deque();
+    constexpr ~deque();
 
     // modifiers
 
     template<typename... Args>
-    iterator emplace(const_iterator, Args&&... args);
+    constexpr iterator emplace(const_iterator, Args&&... args);
 
-    iterator insert(const_iterator pos, value_type value);
+    constexpr iterator insert(const_iterator pos, value_type value);
 
-    iterator erase(const_iterator pos);
+    constexpr iterator erase(const_iterator pos);
 
-    void clear();
+    constexpr void clear();
 
-    void push_back(value_type value);
+    constexpr void push_back(value_type value);
 
-    void push_front(value_type value);
+    constexpr void push_front(value_type value);
 
     template <typename... Args>
-    void emplace_back(Args&&... args); 
+    constexpr void emplace_back(Args&&... args); 
 
     template <typename... Args>
-    void emplace_front(Args&&... args); 
+    constexpr void emplace_front(Args&&... args); 
 
-    void pop_back();
+    constexpr void pop_back();
 
-    void pop_front();
+    constexpr void pop_front();
 
-    void shrink_to_fit();
+    constexpr void pop_front(size_type count);
 
-    void resize(size_type count);
+    constexpr void shrink_to_fit();
 
-    void resize(size_type count, const value_type& value);
+    constexpr void resize(size_type count);
+
+    constexpr void resize(size_type count, const value_type& value);
 
     template <typename U, typename A>
-    friend void swap(deque<U, A>& to, deque<U, A>& from);
+    friend constexpr void swap(deque<U, A>& to, deque<U, A>& from);
 
     // accessors
     template <typename Self>
@@ -133,12 +142,12 @@ public:
         return std::forward<Self>(self).outer_[bi][ri];
     }
 
-    size_type size() const { return sz_; }
+    constexpr size_type size() const { return sz_; }
 
     // TODO:
-    size_type capacity() const { return -1; }
+    constexpr size_type capacity() const { return -1; }
 
-    [[nodiscard]] bool empty() { return !sz_; }
+    [[nodiscard]] constexpr bool empty() { return !sz_; }
 
     // TODO:
     template <typename Self>
@@ -167,33 +176,63 @@ public:
 
     // iterator
 
-    iterator begin() {
+    constexpr iterator begin() {
         return {outer_.data(), ai_};
     }
 
-    iterator end() {
+    constexpr iterator end() {
         return {outer_.data(), ai_ + sz_};
     }
 
     
-    const_iterator begin() const {
+    constexpr const_iterator begin() const {
         return {outer_.data(), ai_};
     }
 
-    const_iterator end() const {
+    constexpr const_iterator end() const {
         return {outer_.data(), ai_ + sz_};
     }
 
-    const_iterator cbegin() const {
+    constexpr const_iterator cbegin() const {
         return {outer_.data(), ai_};
     }
 
-    const_iterator cend() const {
+    constexpr const_iterator cend() const {
         return {outer_.data(), ai_ + sz_};
     }
 
+    // contiguous per-block spans
+
+    constexpr segment_view<value_type, BlockSize> segments() {
+        return {outer_.data(), ai_, ai_ + sz_};
+    }
+
+    constexpr segment_view<const value_type, BlockSize> segments() const {
+        return {outer_.data(), ai_, ai_ + sz_};
+    }
+
+    // streaming
+
+    // calls f for every element, prefetching the first lines of the block
+    // that lies distance blocks ahead, so the scan doesn't stall at every
+    // block boundary; lines is capped by the size of a block
+    template <typename Self, typename F>
+    void for_each_prefetched(this Self&& self, F f,
+            size_type distance = prefetchDistance,
+            size_type lines = prefetchLines);
+
+    // overwrite existing elements with non-temporal stores, so big bulk
+    // writes don't evict the working set of other threads from the LLC
+    template <std::contiguous_iterator It>
+    iterator stream_copy(It first, It last, iterator d_first)
+        requires std::is_trivially_copyable_v<T>
+            && std::same_as<std::iter_value_t<It>, T>;
+
+    void stream_fill(iterator first, iterator last, const value_type& value)
+        requires std::is_trivially_copyable_v<T>;
+
 private:
-    std::tuple<size_t, size_t, size_t, size_t> getCapacityState() const {
+    constexpr std::tuple<size_t, size_t, size_t, size_t> getCapacityState() const {
         auto totalNumberOfCells = outer_.size() * BlockSize;
         auto freeBlocksFromBot = (totalNumberOfCells - (ai_ + sz_) + 1) / BlockSize;
         auto freeBlocksFromTop = ai_ / BlockSize;
@@ -201,6 +240,10 @@ private:
         return {totalNumberOfCells, freeBlocksFromBot, freeBlocksFromTop, occupiedBlocks};
     }
 
+    constexpr void reserveBack();
+
+    constexpr void reserveFront();
+
     template <std::input_iterator InputIt,
              std::forward_iterator NoThrowForwardIt>
     auto uninitialized_move(
@@ -217,7 +260,7 @@ private:
             NoThrowForwardIt d_first,
             UnaryPred P = [](){return false;}) -> NoThrowForwardIt;
 
-    void allocateBlocks(vector<pointer, rebinded>& v, size_t start, size_t stop) {
+    constexpr void allocateBlocks(std::vector<pointer, rebinded>& v, size_t start, size_t stop) {
         size_t i = start;
         try {
             for (; i < stop; ++i) {
@@ -233,10 +276,12 @@ private:
         }
     }
 
-    void deallocateBlocks(vector<pointer, rebinded>& v, size_t pos = 0) {
+    constexpr void deallocateBlocks(std::vector<pointer, rebinded>& v, size_t pos = 0) {
         for (size_t i = pos; i < v.size(); ++i) {
-            alloc_traits::deallocate(alloc_, v[i], BlockSize);
-            v[i] = nullptr;
+            if (v[i]) {
+                alloc_traits::deallocate(alloc_, v[i], BlockSize);
+                v[i] = nullptr;
+            }
         }
     }
 
@@ -257,87 +302,89 @@ private:
         base_iterator& operator=(base_iterator&&) = default;
         ~base_iterator() = default;
 
-        friend difference_type operator-(base_iterator a,
+        friend constexpr difference_type operator-(base_iterator a,
                 base_iterator b) {
             return a.ai_ - b.ai_;
         }
 
-        friend base_iterator operator+(base_iterator it,
+        friend constexpr base_iterator operator+(base_iterator it,
                                                difference_type index) {
            it.ai_ += index;
            return {it};
         }
 
-        friend base_iterator operator-(base_iterator it,
+        friend constexpr base_iterator operator-(base_iterator it,
                                                difference_type index) {
            it.ai_ -= index;
            return {it};
         }
 
-        friend base_iterator operator+(difference_type index,
+        friend constexpr base_iterator operator+(difference_type index,
                                                base_iterator it) {
            it.ai_ += index;
            return {it};
         }
 
-        friend base_iterator operator-(difference_type index,
+        friend constexpr base_iterator operator-(difference_type index,
                                                base_iterator it) {
            it.ai_ -= index;
            return {it};
         }
 
-        iterator& operator+=(difference_type index) {
+        constexpr base_iterator& operator+=(difference_type index) {
             ai_ += index;
+            return *this;
         }
 
-        iterator& operator-=(difference_type index) {
+        constexpr base_iterator& operator-=(difference_type index) {
             ai_ -= index;
+            return *this;
         }
 
-        base_iterator& operator++() {
+        constexpr base_iterator& operator++() {
             ++ai_;
             return *this;
         }
 
-        base_iterator operator++(int) {
+        constexpr base_iterator operator++(int) {
             base_iterator it = *this;
             ++ai_;
             return it;
         }
 
-        base_iterator& operator--() {
+        constexpr base_iterator& operator--() {
             --ai_;
             return *this;
         }
 
-        base_iterator operator--(int) {
+        constexpr base_iterator operator--(int) {
             base_iterator it = *this;
             --ai_;
             return it;
         }
 
-        reference operator*() const {
+        constexpr reference operator*() const {
             auto bi = ai_ / BlockSize;
             auto ri = ai_ % BlockSize;
             return ptr_[bi][ri];
         }
 
-        pointer operator->() const {
+        constexpr pointer operator->() const {
             auto bi = ai_ / BlockSize;
             auto ri = ai_ % BlockSize;
             return ptr_[bi] + ri;
         }
 
-        auto operator<=>(const base_iterator& it) const = default;
+        constexpr auto operator<=>(const base_iterator& it) const = default;
 
-        operator base_iterator<true>() const {
+        constexpr operator base_iterator<true>() const {
             return {ptr_, ai_};
         }
 
     private:
         pointer_to_pointer ptr_;
         size_t ai_;
-        base_iterator(pointer_to_pointer ptr, size_t ai) noexcept
+        constexpr base_iterator(pointer_to_pointer ptr, size_t ai) noexcept
             : ptr_{ptr}, ai_{ai} {}
     };
 };
@@ -10,7 +10,7 @@ namespace ktx {
 // public
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::deque(const std::initializer_list<value_type> items, Allocator alloc) : ai_{0}, sz_{std::size(items)} {
+constexpr deque<T, Allocator>::deque(const std::initializer_list<value_type> items, Allocator alloc) : ai_{0}, sz_{std::size(items)} {
     auto blocks_count = sz_*2 / BlockSize + (sz_*2 % BlockSize ? 1 : 0);
     auto count_of_free_cells = blocks_count * BlockSize;
     ai_ = (count_of_free_cells - sz_) / 2;
@@ -35,7 +35,7 @@ deque<T, Allocator>::deque(const std::initializer_list<value_type> items, Alloca
 }
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::deque(size_type n, const T& val, Allocator a) : ai_{0}, sz_{n} {
+constexpr deque<T, Allocator>::deque(size_type n, const T& val, Allocator a) : ai_{0}, sz_{n} {
     auto blocks_count = n*2 / BlockSize + (n*2 % BlockSize ? 1 : 0);
     auto count_of_free_cells = blocks_count * BlockSize;
     ai_ = (count_of_free_cells - n) / 2;
@@ -59,7 +59,7 @@ deque<T, Allocator>::deque(size_type n, const T& val, Allocator a) : ai_{0}, sz_
 
 template <typename T, typename Allocator>
 template <std::forward_iterator Iter>
-deque<T, Allocator>::deque(Iter fst, Iter lst): ai_{0}, sz_{0} {
+constexpr deque<T, Allocator>::deque(Iter fst, Iter lst): ai_{0}, sz_{0} {
     if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
             typename std::iterator_traits<Iter>::iterator_category>) {
         sz_ = std::distance(fst, lst);
@@ -89,7 +89,7 @@ deque<T, Allocator>::deque(Iter fst, Iter lst): ai_{0}, sz_{0} {
 }
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::deque(const deque<T, Allocator>& other)
+constexpr deque<T, Allocator>::deque(const deque<T, Allocator>& other)
     : ai_{other.ai_}
     , sz_{other.sz_}
     , outer_{}
@@ -113,94 +113,44 @@ deque<T, Allocator>::deque(const deque<T, Allocator>& other)
 
 template <typename T, typename Allocator>
 template <typename... Args>
-void deque<T, Allocator>::emplace_back(Args&&... args) {
-    if (outer_.empty()) {
-        outer_.push_back(nullptr);
-        allocateBlocks(outer_, 0, 1);
-        ai_ = BlockSize / 2 - 1;
-    }
-    auto [n, freeBlocksFromBot, freeBlocksFromTop, occupiedBlocks] = getCapacityState();
-
-    if (ai_ + sz_ < n) {
-        alloc_traits::construct(alloc_, &*end(), std::forward<Args>(args)...);
-        ++sz_;
-        return;
-    }
-    const auto newBlockCount = occupiedBlocks * expansion + outer_.size();
-    vector<pointer, rebinded> newOuter(newBlockCount);
-
-    size_t i = 0;
-    for (; i < outer_.size(); ++i) {
-        newOuter[i] = outer_[i];
-    }
-    allocateBlocks(newOuter, i, newBlockCount);
-
-    try {
-        alloc_traits::construct(alloc_, &newOuter[i][0], std::forward<Args>(args)...);
-    } catch (...) {
-        deallocateBlocks(newOuter, i);
+constexpr void deque<T, Allocator>::emplace_back(Args&&... args) {
+    if (ai_ + sz_ == outer_.size() * BlockSize) {
+        reserveBack();
     }
-
-    swap(outer_, newOuter);
+    alloc_traits::construct(alloc_, &*end(), std::forward<Args>(args)...);
     ++sz_;
 }
 
 template <typename T, typename Allocator>
 template <typename... Args>
-void deque<T, Allocator>::emplace_front(Args&&... args) {
-    if (outer_.empty()) {
-        outer_.push_back(nullptr);
-        allocateBlocks(outer_, 0, 1);
-        ai_ = BlockSize / 2 - 1;
-    }
-    auto [n, freeBlocksFromBot, freeBlocksFromTop, occupiedBlocks] = getCapacityState();
-
-    if (ai_ != 0) {
-        alloc_traits::construct(alloc_, &*(begin() - 1), std::forward<Args>(args)...);
-        --ai_;
-        ++sz_;
-        return;
-    }
-    const auto newBlockCount = occupiedBlocks * expansion + outer_.size();
-    vector<pointer, rebinded> newOuter(newBlockCount);
-
-    size_t offset = newBlockCount - outer_.size();
-    allocateBlocks(newOuter, 0, offset);
-    for (size_t i = 0; i < outer_.size(); ++i) {
-        newOuter[i + offset] = outer_[i];
+constexpr void deque<T, Allocator>::emplace_front(Args&&... args) {
+    if (ai_ == 0) {
+        reserveFront();
     }
-
-    try {
-        alloc_traits::construct(alloc_, &newOuter[offset - 1][BlockSize - 1], std::forward<Args>(args)...);
-    } catch (...) {
-        deallocateBlocks(newOuter, offset);
-    }
-
-    swap(outer_, newOuter);
-    ai_ += offset * BlockSize;
+    alloc_traits::construct(alloc_, &*(begin() - 1), std::forward<Args>(args)...);
     --ai_;
     ++sz_;
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::push_back(value_type value) { 
+constexpr void deque<T, Allocator>::push_back(value_type value) { 
     emplace_back(std::move(value));
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::push_front(value_type value) { 
+constexpr void deque<T, Allocator>::push_front(value_type value) { 
     emplace_front(std::move(value));
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::clear() {
+constexpr void deque<T, Allocator>::clear() {
     for (auto& i: *this) {
         alloc_traits::destroy(alloc_, &i);
     }
 }
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::~deque() {
+constexpr deque<T, Allocator>::~deque() {
     clear();
     deallocateBlocks(outer_);
 }
@@ -220,7 +170,7 @@ std::conditional_t<
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::resize(size_type count, const value_type& val) {
+constexpr void deque<T, Allocator>::resize(size_type count, const value_type& val) {
     if (sz_ == count) {
         return;
     }
@@ -241,12 +191,12 @@ void deque<T, Allocator>::resize(size_type count, const value_type& val) {
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::resize(size_type count) {
+constexpr void deque<T, Allocator>::resize(size_type count) {
     resize(count, T());
 }
 
 template<typename T, typename Allocator>
-void deque<T, Allocator>::shrink_to_fit() {
+constexpr void deque<T, Allocator>::shrink_to_fit() {
     if (empty()) {
         deallocateBlocks(outer_, 0);
     }
@@ -268,18 +218,35 @@ void deque<T, Allocator>::shrink_to_fit() {
 }
 
 template <typename T, typename Allocator>
-void deque<T, Allocator>::pop_back() {
+constexpr void deque<T, Allocator>::pop_back() {
     erase(cend() - 1);
 }
 
 template <typename T, typename Allocator>
-void deque<T, Allocator>::pop_front() {
+constexpr void deque<T, Allocator>::pop_front() {
     erase(cbegin());
 }
 
+// drops count elements from the front at once, without shifting anything
+template <typename T, typename Allocator>
+constexpr void deque<T, Allocator>::pop_front(size_type count) {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+        for (auto segment: segment_view<value_type, BlockSize>{outer_.data(), ai_, ai_ + count}) {
+            for (auto& i: segment) {
+                alloc_traits::destroy(alloc_, std::addressof(i));
+            }
+        }
+    }
+    ai_ += count;
+    sz_ -= count;
+    if (!sz_) {
+        ai_ = outer_.size() * BlockSize / 2;
+    }
+}
+
 template<typename T, typename Allocator>
 template<typename... Args>
-deque<T, Allocator>::iterator deque<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
+constexpr deque<T, Allocator>::iterator deque<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
     auto distance_to_begin = std::distance(cbegin(), pos);
     auto distance_to_end = std::distance(pos, cend());
     iterator p = begin() + std::distance(cbegin(), pos);
@@ -300,12 +267,12 @@ deque<T, Allocator>::iterator deque<T, Allocator>::emplace(const_iterator pos, A
 }
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::iterator deque<T, Allocator>::insert(const_iterator pos, value_type value) {
+constexpr deque<T, Allocator>::iterator deque<T, Allocator>::insert(const_iterator pos, value_type value) {
     return emplace(pos, std::move(value));
 }
 
 template<typename T, typename Allocator>
-deque<T, Allocator>::iterator deque<T, Allocator>::erase(const_iterator pos) {
+constexpr deque<T, Allocator>::iterator deque<T, Allocator>::erase(const_iterator pos) {
     auto distance_to_begin = std::distance(cbegin(), pos);
     auto distance_to_end = std::distance(pos, cend());
     iterator p = begin() + std::distance(cbegin(), pos);
@@ -323,12 +290,157 @@ deque<T, Allocator>::iterator deque<T, Allocator>::erase(const_iterator pos) {
         ++ai_;
     }
     --sz_;
+    if (!sz_) {
+        // keep room on both sides, otherwise a drained deque can be left
+        // with ai_ at the very end of the map
+        ai_ = outer_.size() * BlockSize / 2;
+        return end();
+    }
 
     return p;
 }
 
+template <typename T, typename Allocator>
+template <typename Self, typename F>
+void deque<T, Allocator>::for_each_prefetched(this Self&& self, F f,
+        size_type distance, size_type lines) {
+    const auto last = self.ai_ + self.sz_;
+    const auto lastBlock = last ? (last - 1) / BlockSize : 0;
+    lines = std::min(lines, blockLines);
+
+    for (auto pos = self.ai_; pos != last;) {
+        const auto bi = pos / BlockSize;
+        if (bi + distance <= lastBlock) {
+            auto next = reinterpret_cast<const char*>(self.outer_[bi + distance]);
+            for (size_t line = 0; line < lines; ++line) {
+                detail::prefetch(next + line * detail::cacheLine);
+            }
+        }
+
+        const auto stop = std::min(last, (bi + 1) * BlockSize);
+        std::conditional_t<
+            std::is_const_v<std::remove_reference_t<Self>>,
+            const value_type*,
+            value_type*> block = self.outer_[bi];
+        for (auto i = pos % BlockSize; pos != stop; ++pos, ++i) {
+            f(block[i]);
+        }
+    }
+}
+
+template <typename T, typename Allocator>
+template <std::contiguous_iterator It>
+deque<T, Allocator>::iterator deque<T, Allocator>::stream_copy(It first, It last,
+        iterator d_first) requires std::is_trivially_copyable_v<T>
+            && std::same_as<std::iter_value_t<It>, T> {
+    auto src = std::to_address(first);
+    auto count = static_cast<size_type>(std::distance(first, last));
+
+    for (auto segment: segment_view<value_type, BlockSize>{outer_.data(), d_first.ai_, d_first.ai_ + count}) {
+        detail::stream_copy(segment.data(), src, segment.size_bytes());
+        src += segment.size();
+    }
+    detail::stream_fence();
+
+    return d_first + count;
+}
+
+template <typename T, typename Allocator>
+void deque<T, Allocator>::stream_fill(iterator first, iterator last,
+        const value_type& value) requires std::is_trivially_copyable_v<T> {
+    // a cached pattern of copies of value is the source for the streaming stores
+    constexpr auto patternSize = std::max<size_t>(256 / sizeof(value_type), 1);
+    alignas(value_type) unsigned char pattern[patternSize * sizeof(value_type)];
+    for (size_t i = 0; i < patternSize; ++i) {
+        std::memcpy(pattern + i * sizeof(value_type), std::addressof(value), sizeof(value_type));
+    }
+
+    for (auto segment: segment_view<value_type, BlockSize>{outer_.data(), first.ai_, last.ai_}) {
+        for (size_t i = 0; i < segment.size(); i += patternSize) {
+            auto n = std::min(patternSize, segment.size() - i);
+            detail::stream_copy(segment.data() + i, pattern, n * sizeof(value_type));
+        }
+    }
+    detail::stream_fence();
+}
+
 // private
 
+// Makes room behind the last element. Free blocks in front of the first
+// element are moved to the back when they are at least as many as the
+// occupied ones, so a deque used as a FIFO keeps recycling its blocks and
+// the map is rotated only once per that many pushes. Otherwise the map
+// grows and new blocks are appended. The first map has expansion blocks,
+// so the centered ai_ is never 0 even when a block holds one element.
+template <typename T, typename Allocator>
+constexpr void deque<T, Allocator>::reserveBack() {
+    if (outer_.empty()) {
+        std::vector<pointer, rebinded> newOuter(expansion);
+        allocateBlocks(newOuter, 0, expansion);
+        swap(outer_, newOuter);
+        ai_ = expansion * BlockSize / 2;
+        return;
+    }
+    if (!sz_) {
+        ai_ = outer_.size() * BlockSize / 2;
+        return;
+    }
+    const auto freeBlocks = ai_ / BlockSize;
+    const auto occupiedBlocks = outer_.size() - freeBlocks;
+
+    if (freeBlocks >= occupiedBlocks) {
+        std::rotate(outer_.begin(), outer_.begin() + freeBlocks, outer_.end());
+        ai_ -= freeBlocks * BlockSize;
+        return;
+    }
+
+    const auto newBlockCount = occupiedBlocks * expansion + outer_.size();
+    std::vector<pointer, rebinded> newOuter(newBlockCount);
+
+    for (size_t i = 0; i < outer_.size(); ++i) {
+        newOuter[i] = outer_[i];
+    }
+    allocateBlocks(newOuter, outer_.size(), newBlockCount);
+
+    swap(outer_, newOuter);
+}
+
+// mirror of reserveBack, makes room before the first element
+template <typename T, typename Allocator>
+constexpr void deque<T, Allocator>::reserveFront() {
+    if (outer_.empty()) {
+        std::vector<pointer, rebinded> newOuter(expansion);
+        allocateBlocks(newOuter, 0, expansion);
+        swap(outer_, newOuter);
+        ai_ = expansion * BlockSize / 2;
+        return;
+    }
+    if (!sz_) {
+        ai_ = outer_.size() * BlockSize / 2;
+        return;
+    }
+    const auto freeBlocks = outer_.size() - (ai_ + sz_ + BlockSize - 1) / BlockSize;
+    const auto occupiedBlocks = outer_.size() - freeBlocks;
+
+    if (freeBlocks >= occupiedBlocks) {
+        std::rotate(outer_.begin(), outer_.end() - freeBlocks, outer_.end());
+        ai_ += freeBlocks * BlockSize;
+        return;
+    }
+
+    const auto newBlockCount = occupiedBlocks * expansion + outer_.size();
+    std::vector<pointer, rebinded> newOuter(newBlockCount);
+
+    const auto offset = newBlockCount - outer_.size();
+    for (size_t i = 0; i < outer_.size(); ++i) {
+        newOuter[i + offset] = outer_[i];
+    }
+    allocateBlocks(newOuter, 0, offset);
+
+    swap(outer_, newOuter);
+    ai_ += offset * BlockSize;
+}
+
 template <typename T, typename Allocator>
 template <std::input_iterator InputIt,
          std::forward_iterator NoThrowForwardIt,
@@ -383,7 +495,7 @@ auto deque<T, Allocator>::uninitialized_move(
 // friend
 
 template<typename T, typename Allocator>
-void swap(deque<T, Allocator>& to, deque<T, Allocator>& from) {
+constexpr void swap(deque<T, Allocator>& to, deque<T, Allocator>& from) {
     std::swap(from.outer_, to.outer_);
     std::swap(from.ai_, to.ai_);
     std::swap(from.sz_, to.sz_);
@@ -0,0 +1,84 @@
+#pragma once
+
+
+#include <span>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+namespace ktx {
+
+
+
+// Walks the occupied cells [first, last) of a block map one block at a time.
+// Every segment is a contiguous std::span, so scans over it can be vectorized.
+template <typename U, std::size_t BlockSize>
+class segment_view {
+private:
+    using block_pointer = std::remove_const_t<U>* const*;
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::span<U>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::span<U>;
+
+        constexpr iterator() = default;
+
+        constexpr reference operator*() const {
+            auto bi = pos_ / BlockSize;
+            auto ri = pos_ % BlockSize;
+            return {blocks_[bi] + ri, next() - pos_};
+        }
+
+        constexpr iterator& operator++() {
+            pos_ = next();
+            return *this;
+        }
+
+        constexpr iterator operator++(int) {
+            iterator it = *this;
+            pos_ = next();
+            return it;
+        }
+
+        friend constexpr bool operator==(const iterator& a, const iterator& b) {
+            return a.pos_ == b.pos_;
+        }
+
+    private:
+        friend class segment_view;
+
+        block_pointer blocks_ = nullptr;
+        std::size_t pos_ = 0;
+        std::size_t last_ = 0;
+
+        constexpr iterator(block_pointer blocks, std::size_t pos, std::size_t last) noexcept
+            : blocks_{blocks}, pos_{pos}, last_{last} {}
+
+        constexpr std::size_t next() const {
+            return std::min(last_, (pos_ / BlockSize + 1) * BlockSize);
+        }
+    };
+
+    constexpr segment_view(block_pointer blocks, std::size_t first, std::size_t last) noexcept
+        : blocks_{blocks}, first_{first}, last_{last} {}
+
+    constexpr iterator begin() const { return {blocks_, first_, last_}; }
+
+    constexpr iterator end() const { return {blocks_, last_, last_}; }
+
+    [[nodiscard]] constexpr bool empty() const { return first_ == last_; }
+
+private:
+    block_pointer blocks_;
+    std::size_t first_;
+    std::size_t last_;
+};
+
+
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+
+#include <memory>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include "ktxsegments.h"
+
+namespace ktx {
+
+
+
+// Structure-of-arrays deque: every field lives in its own blocks, all block
+// maps share one ai_/sz_, so row i is the i-th cell of every field.
+template <typename... Fields>
+class soa_deque {
+    static_assert(sizeof...(Fields) > 0, "soa_deque needs at least one field");
+
+private:
+    template <bool isConst>
+    class base_iterator;
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    using iterator = base_iterator<false>;
+    using const_iterator = base_iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, value_type>;
+
+private:
+    size_type ai_;
+    size_type sz_;
+
+    // one block map per field, all of them always have the same size
+    std::tuple<std::vector<Fields*>...> outer_;
+
+    static constexpr auto chunkSize = 512ULL;
+    static constexpr size_t BlockSize = []() -> size_t {
+        constexpr auto widest = std::max({sizeof(Fields)...});
+        if constexpr (chunkSize / widest != 0) {
+            return chunkSize / widest;
+        } else {
+            return 8ULL;
+        }
+    }();
+    static constexpr size_t expansion = 2;
+
+    using indices = std::index_sequence_for<Fields...>;
+
+public:
+    // constructors and assign
+    soa_deque() : ai_{0}, sz_{0}, outer_{} {}
+
+    soa_deque(const soa_deque& other);
+
+    soa_deque(soa_deque&& other) noexcept : soa_deque{} { swap(*this, other); }
+
+    soa_deque& operator=(soa_deque other) {
+        swap(*this, other);
+        return *this;
+    }
+
+    // dtor
+    ~soa_deque();
+
+    // modifiers
+
+    void push_back(Fields... values);
+
+    void push_front(Fields... values);
+
+    void pop_back();
+
+    void pop_front();
+
+    void clear();
+
+    template <typename... Ts>
+    friend void swap(soa_deque<Ts...>& to, soa_deque<Ts...>& from);
+
+    // accessors
+    reference operator[](size_type index) {
+        return row(ai_ + index, indices{});
+    }
+
+    const_reference operator[](size_type index) const {
+        return row(ai_ + index, indices{});
+    }
+
+    template <size_t I>
+    field_type<I>& get(size_type index) {
+        return *slot<I>(ai_ + index);
+    }
+
+    template <size_t I>
+    const field_type<I>& get(size_type index) const {
+        return *slot<I>(ai_ + index);
+    }
+
+    size_type size() const { return sz_; }
+
+    [[nodiscard]] bool empty() const { return !sz_; }
+
+    // contiguous per-block spans of a single field
+
+    template <size_t I>
+    segment_view<field_type<I>, BlockSize> segments() {
+        return {std::get<I>(outer_).data(), ai_, ai_ + sz_};
+    }
+
+    template <size_t I>
+    segment_view<const field_type<I>, BlockSize> segments() const {
+        return {std::get<I>(outer_).data(), ai_, ai_ + sz_};
+    }
+
+    // iterator
+
+    iterator begin() {
+        return {this, ai_};
+    }
+
+    iterator end() {
+        return {this, ai_ + sz_};
+    }
+
+    const_iterator begin() const {
+        return {this, ai_};
+    }
+
+    const_iterator end() const {
+        return {this, ai_ + sz_};
+    }
+
+    const_iterator cbegin() const {
+        return {this, ai_};
+    }
+
+    const_iterator cend() const {
+        return {this, ai_ + sz_};
+    }
+
+private:
+    size_type mapSize() const { return std::get<0>(outer_).size(); }
+
+    template <size_t I>
+    field_type<I>* slot(size_type pos) const {
+        return std::get<I>(outer_)[pos / BlockSize] + pos % BlockSize;
+    }
+
+    template <size_t... Is>
+    reference row(size_type pos, std::index_sequence<Is...>) {
+        return {*slot<Is>(pos)...};
+    }
+
+    template <size_t... Is>
+    const_reference row(size_type pos, std::index_sequence<Is...>) const {
+        return {*slot<Is>(pos)...};
+    }
+
+    template <size_t I = 0, typename Arg, typename... Rest>
+    void constructFields(size_type pos, Arg&& arg, Rest&&... rest);
+
+    template <size_t... Is>
+    void destroyRow(size_type pos, std::index_sequence<Is...>) {
+        (std::destroy_at(slot<Is>(pos)), ...);
+    }
+
+    template <size_t... Is>
+    void copyRow(const soa_deque& other, size_type pos, std::index_sequence<Is...>) {
+        constructFields(pos, *other.template slot<Is>(pos)...);
+    }
+
+    void grow(bool atFront);
+
+    template <size_t I = 0>
+    void relocateMaps(std::tuple<std::vector<Fields*>...>& newOuter,
+            size_t offset, size_t newBlockCount);
+
+    template <size_t... Is>
+    void rotateMaps(bool atFront, size_t count, std::index_sequence<Is...>) {
+        (rotateMap(std::get<Is>(outer_), atFront, count), ...);
+    }
+
+    template <typename F>
+    static void rotateMap(std::vector<F*>& v, bool atFront, size_t count) {
+        if (atFront) {
+            std::rotate(v.begin(), v.end() - count, v.end());
+        } else {
+            std::rotate(v.begin(), v.begin() + count, v.end());
+        }
+    }
+
+    template <size_t... Is>
+    void releaseMaps(std::index_sequence<Is...>) {
+        (deallocateBlocks(std::get<Is>(outer_), 0, mapSize()), ...);
+    }
+
+    template <typename F>
+    static void allocateBlocks(std::vector<F*>& v, size_t start, size_t stop) {
+        std::allocator<F> alloc;
+        size_t i = start;
+        try {
+            for (; i < stop; ++i) {
+                v[i] = alloc.allocate(BlockSize);
+            }
+        } catch (std::bad_alloc&) {
+            deallocateBlocks(v, start, i);
+            throw;
+        }
+    }
+
+    template <typename F>
+    static void deallocateBlocks(std::vector<F*>& v, size_t start, size_t stop) {
+        std::allocator<F> alloc;
+        for (size_t i = start; i < stop; ++i) {
+            alloc.deallocate(v[i], BlockSize);
+            v[i] = nullptr;
+        }
+    }
+
+    template<bool isConst>
+    class base_iterator {
+    public:
+        friend class soa_deque<Fields...>;
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+        using value_type = soa_deque<Fields...>::value_type;
+        using difference_type = ptrdiff_t;
+        using reference = std::conditional_t<isConst,
+              soa_deque<Fields...>::const_reference,
+              soa_deque<Fields...>::reference>;
+        using owner_pointer = std::conditional_t<isConst,
+              const soa_deque<Fields...>*,
+              soa_deque<Fields...>*>;
+
+        base_iterator() = default;
+
+        friend difference_type operator-(base_iterator a, base_iterator b) {
+            return a.ai_ - b.ai_;
+        }
+
+        friend base_iterator operator+(base_iterator it, difference_type index) {
+            it.ai_ += index;
+            return it;
+        }
+
+        friend base_iterator operator+(difference_type index, base_iterator it) {
+            it.ai_ += index;
+            return it;
+        }
+
+        friend base_iterator operator-(base_iterator it, difference_type index) {
+            it.ai_ -= index;
+            return it;
+        }
+
+        base_iterator& operator+=(difference_type index) {
+            ai_ += index;
+            return *this;
+        }
+
+        base_iterator& operator-=(difference_type index) {
+            ai_ -= index;
+            return *this;
+        }
+
+        base_iterator& operator++() {
+            ++ai_;
+            return *this;
+        }
+
+        base_iterator operator++(int) {
+            base_iterator it = *this;
+            ++ai_;
+            return it;
+        }
+
+        base_iterator& operator--() {
+            --ai_;
+            return *this;
+        }
+
+        base_iterator operator--(int) {
+            base_iterator it = *this;
+            --ai_;
+            return it;
+        }
+
+        reference operator*() const {
+            return owner_->row(ai_, indices{});
+        }
+
+        reference operator[](difference_type index) const {
+            return owner_->row(ai_ + index, indices{});
+        }
+
+        friend bool operator==(const base_iterator& a, const base_iterator& b) {
+            return a.ai_ == b.ai_;
+        }
+
+        friend auto operator<=>(const base_iterator& a, const base_iterator& b) {
+            return a.ai_ <=> b.ai_;
+        }
+
+        operator base_iterator<true>() const {
+            return {owner_, ai_};
+        }
+
+    private:
+        owner_pointer owner_ = nullptr;
+        size_t ai_ = 0;
+        base_iterator(owner_pointer owner, size_t ai) noexcept
+            : owner_{owner}, ai_{ai} {}
+    };
+};
+
+
+}
+
+#include "ktxsoadeque_realization.h" // IWYU pragma: keep
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "ktxsoadeque.h"
+
+
+namespace ktx {
+
+
+
+// public
+
+template <typename... Fields>
+soa_deque<Fields...>::soa_deque(const soa_deque<Fields...>& other)
+    : ai_{other.ai_}
+    , sz_{0}
+    , outer_{} {
+    std::tuple<std::vector<Fields*>...> newOuter;
+    relocateMaps(newOuter, 0, other.mapSize());
+    std::swap(outer_, newOuter);
+    try {
+        for (; sz_ < other.sz_; ++sz_) {
+            copyRow(other, ai_ + sz_, indices{});
+        }
+    } catch (...) {
+        clear();
+        releaseMaps(indices{});
+        throw;
+    }
+}
+
+template <typename... Fields>
+soa_deque<Fields...>::~soa_deque() {
+    clear();
+    releaseMaps(indices{});
+}
+
+template <typename... Fields>
+void soa_deque<Fields...>::push_back(Fields... values) {
+    if (ai_ + sz_ == mapSize() * BlockSize) {
+        grow(false);
+    }
+    constructFields(ai_ + sz_, std::move(values)...);
+    ++sz_;
+}
+
+template <typename... Fields>
+void soa_deque<Fields...>::push_front(Fields... values) {
+    if (ai_ == 0) {
+        grow(true);
+    }
+    constructFields(ai_ - 1, std::move(values)...);
+    --ai_;
+    ++sz_;
+}
+
+template <typename... Fields>
+void soa_deque<Fields...>::pop_back() {
+    destroyRow(ai_ + sz_ - 1, indices{});
+    --sz_;
+    if (!sz_) {
+        ai_ = mapSize() * BlockSize / 2;
+    }
+}
+
+template <typename... Fields>
+void soa_deque<Fields...>::pop_front() {
+    destroyRow(ai_, indices{});
+    ++ai_;
+    --sz_;
+    if (!sz_) {
+        ai_ = mapSize() * BlockSize / 2;
+    }
+}
+
+template <typename... Fields>
+void soa_deque<Fields...>::clear() {
+    for (; sz_; --sz_) {
+        destroyRow(ai_ + sz_ - 1, indices{});
+    }
+}
+
+// private
+
+template <typename... Fields>
+template <size_t I, typename Arg, typename... Rest>
+void soa_deque<Fields...>::constructFields(size_type pos,
+        Arg&& arg, Rest&&... rest) {
+    auto p = slot<I>(pos);
+    std::construct_at(p, std::forward<Arg>(arg));
+    if constexpr (sizeof...(Rest) != 0) {
+        try {
+            constructFields<I + 1>(pos, std::forward<Rest>(rest)...);
+        } catch (...) {
+            std::destroy_at(p);
+            throw;
+        }
+    }
+}
+
+// Free blocks on the other side of the rows are rotated to the growing side
+// when there are at least as many as occupied ones, like deque does, so a
+// FIFO keeps reusing its blocks. Otherwise every block map grows.
+template <typename... Fields>
+void soa_deque<Fields...>::grow(bool atFront) {
+    const auto oldBlockCount = mapSize();
+    if (oldBlockCount && !sz_) {
+        ai_ = oldBlockCount * BlockSize / 2;
+        return;
+    }
+    const size_t occupiedBlocks = sz_
+        ? (ai_ + sz_ - 1) / BlockSize - ai_ / BlockSize + 1
+        : 0;
+    const size_t freeBlocks = atFront
+        ? oldBlockCount - (ai_ + sz_ + BlockSize - 1) / BlockSize
+        : ai_ / BlockSize;
+
+    if (oldBlockCount && freeBlocks >= occupiedBlocks) {
+        rotateMaps(atFront, freeBlocks, indices{});
+        if (atFront) {
+            ai_ += freeBlocks * BlockSize;
+        } else {
+            ai_ -= freeBlocks * BlockSize;
+        }
+        return;
+    }
+
+    const auto addedBlocks = std::max<size_t>(occupiedBlocks, 1) * expansion;
+    const auto newBlockCount = oldBlockCount + addedBlocks;
+    const auto offset = atFront ? addedBlocks : 0;
+
+    std::tuple<std::vector<Fields*>...> newOuter;
+    relocateMaps(newOuter, offset, newBlockCount);
+    std::swap(outer_, newOuter);
+
+    if (oldBlockCount == 0) {
+        ai_ = newBlockCount * BlockSize / 2;
+    } else {
+        ai_ += offset * BlockSize;
+    }
+}
+
+// Copies the block pointers of every field into newOuter shifted by offset
+// and allocates the new blocks around them. If any allocation fails, the
+// blocks allocated for the already processed fields are released.
+template <typename... Fields>
+template <size_t I>
+void soa_deque<Fields...>::relocateMaps(std::tuple<std::vector<Fields*>...>& newOuter,
+        size_t offset, size_t newBlockCount) {
+    if constexpr (I < sizeof...(Fields)) {
+        auto& from = std::get<I>(outer_);
+        auto& to = std::get<I>(newOuter);
+        const auto tail = offset + from.size();
+
+        to.resize(newBlockCount);
+        for (size_t i = 0; i < from.size(); ++i) {
+            to[i + offset] = from[i];
+        }
+
+        allocateBlocks(to, 0, offset);
+        try {
+            allocateBlocks(to, tail, newBlockCount);
+        } catch (...) {
+            deallocateBlocks(to, 0, offset);
+            throw;
+        }
+
+        try {
+            relocateMaps<I + 1>(newOuter, offset, newBlockCount);
+        } catch (...) {
+            deallocateBlocks(to, 0, offset);
+            deallocateBlocks(to, tail, newBlockCount);
+            throw;
+        }
+    }
+}
+
+// friend
+
+template <typename... Fields>
+void swap(soa_deque<Fields...>& to, soa_deque<Fields...>& from) {
+    std::swap(from.outer_, to.outer_);
+    std::swap(from.ai_, to.ai_);
+    std::swap(from.sz_, to.sz_);
+}
+
+
+
+};
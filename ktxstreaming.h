@@ -0,0 +1,62 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define KTX_STREAMING_SSE2 1
+#endif
+
+namespace ktx::detail {
+
+
+
+inline constexpr std::size_t cacheLine = 64;
+
+// hint that p is going to be read soon
+inline void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(KTX_STREAMING_SSE2)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#endif
+}
+
+// memcpy with non-temporal stores, the written lines go straight to memory
+// instead of pushing other data out of the caches. Without SSE2 it's memcpy.
+inline void stream_copy(void* dst, const void* src, std::size_t bytes) {
+#if defined(KTX_STREAMING_SSE2)
+    auto d = static_cast<char*>(dst);
+    auto s = static_cast<const char*>(src);
+
+    auto head = (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % 16;
+    if (head > bytes) {
+        head = bytes;
+    }
+    std::memcpy(d, s, head);
+    d += head;
+    s += head;
+    bytes -= head;
+
+    for (; bytes >= 16; d += 16, s += 16, bytes -= 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+    }
+    std::memcpy(d, s, bytes);
+#else
+    std::memcpy(dst, src, bytes);
+#endif
+}
+
+// orders the non-temporal stores before any following store
+inline void stream_fence() {
+#if defined(KTX_STREAMING_SSE2)
+    _mm_sfence();
+#endif
+}
+
+
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+
+#include <functional>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include "ktxdeque.h"
+
+namespace ktx {
+
+
+
+// Monoids for window_aggregate: identity() is the neutral element and
+// combine(a, b) aggregates a (older) with b (newer).
+
+template <typename T>
+struct sum_monoid {
+    static T identity() { return T{}; }
+    static T combine(const T& a, const T& b) { return a + b; }
+};
+
+template <typename T>
+struct min_monoid {
+    static T identity() { return std::numeric_limits<T>::max(); }
+    static T combine(const T& a, const T& b) { return std::min(a, b); }
+};
+
+template <typename T>
+struct max_monoid {
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T combine(const T& a, const T& b) { return std::max(a, b); }
+};
+
+template <typename M, typename T>
+concept monoid = requires (const M& m, const T& a, const T& b) {
+    { m.identity() } -> std::convertible_to<T>;
+    { m.combine(a, b) } -> std::convertible_to<T>;
+};
+
+
+// Sliding window that answers "greatest element by Cmp" in O(1), like
+// std::priority_queue: std::less gives the maximum, std::greater the minimum.
+// Only the candidates that can still become top() are kept, ordered by age.
+template <typename T, typename Cmp = std::less<T>>
+class monotonic_window {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+
+private:
+    // (sequence number, value), sequence numbers grow from front to back
+    deque<std::pair<size_type, value_type>> candidates_;
+    size_type head_;
+    size_type tail_;
+    [[no_unique_address]] Cmp cmp_;
+
+public:
+    monotonic_window() : candidates_{}, head_{0}, tail_{0}, cmp_{} {}
+
+    explicit monotonic_window(Cmp cmp)
+        : candidates_{}, head_{0}, tail_{0}, cmp_{std::move(cmp)} {}
+
+    // modifiers
+
+    void push(value_type value);
+
+    // evicts the count oldest elements of the window
+    void evict(size_type count = 1);
+
+    // accessors
+
+    const_reference top() const { return candidates_[0].second; }
+
+    size_type size() const { return tail_ - head_; }
+
+    [[nodiscard]] bool empty() const { return head_ == tail_; }
+};
+
+
+// Two-stack sliding window aggregate with amortized O(1) push, evict and
+// query for any associative Monoid. The back stack keeps raw values and
+// their running aggregate, the front stack keeps every value together with
+// the aggregate of it and all newer values of the front stack.
+template <typename T, monoid<T> Monoid = sum_monoid<T>>
+class window_aggregate {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const value_type&;
+
+private:
+    deque<std::pair<value_type, value_type>> front_;
+    deque<value_type> back_;
+    value_type backAgg_;
+    [[no_unique_address]] Monoid monoid_;
+
+public:
+    window_aggregate() : front_{}, back_{}, backAgg_{Monoid{}.identity()}, monoid_{} {}
+
+    explicit window_aggregate(Monoid m)
+        : front_{}, back_{}, backAgg_{m.identity()}, monoid_{std::move(m)} {}
+
+    // modifiers
+
+    void push(value_type value);
+
+    // evicts the count oldest elements of the window
+    void evict(size_type count = 1);
+
+    // evicts the oldest elements while pred holds for them, e.g. for
+    // time-based windows pred checks the timestamp against the cutoff
+    template <std::predicate<const value_type&> Pred>
+    void evict_while(Pred pred);
+
+    // accessors
+
+    value_type query() const;
+
+    const_reference oldest() const {
+        return front_.size() ? front_[0].first : back_[0];
+    }
+
+    size_type size() const { return front_.size() + back_.size(); }
+
+    [[nodiscard]] bool empty() const { return !size(); }
+
+private:
+    void flip();
+};
+
+
+}
+
+#include "ktxwindow_realization.h" // IWYU pragma: keep
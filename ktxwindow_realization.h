@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ktxwindow.h"
+
+
+namespace ktx {
+
+
+
+// monotonic_window
+
+template <typename T, typename Cmp>
+void monotonic_window<T, Cmp>::push(value_type value) {
+    while (candidates_.size() &&
+            cmp_(candidates_[candidates_.size() - 1].second, value)) {
+        candidates_.pop_back();
+    }
+    candidates_.emplace_back(tail_, std::move(value));
+    ++tail_;
+}
+
+template <typename T, typename Cmp>
+void monotonic_window<T, Cmp>::evict(size_type count) {
+    head_ += std::min(count, size());
+
+    size_type expired = 0;
+    while (expired < candidates_.size() && candidates_[expired].first < head_) {
+        ++expired;
+    }
+    candidates_.pop_front(expired);
+}
+
+// window_aggregate
+
+template <typename T, monoid<T> Monoid>
+void window_aggregate<T, Monoid>::push(value_type value) {
+    backAgg_ = monoid_.combine(backAgg_, value);
+    back_.push_back(std::move(value));
+}
+
+template <typename T, monoid<T> Monoid>
+void window_aggregate<T, Monoid>::evict(size_type count) {
+    count = std::min(count, size());
+    while (count) {
+        if (!front_.size()) {
+            flip();
+        }
+        auto n = std::min(count, front_.size());
+        front_.pop_front(n);
+        count -= n;
+    }
+}
+
+template <typename T, monoid<T> Monoid>
+template <std::predicate<const T&> Pred>
+void window_aggregate<T, Monoid>::evict_while(Pred pred) {
+    while (size()) {
+        if (!front_.size()) {
+            flip();
+        }
+        size_type n = 0;
+        while (n < front_.size() && pred(std::as_const(front_[n].first))) {
+            ++n;
+        }
+        front_.pop_front(n);
+        if (front_.size()) {
+            return;
+        }
+    }
+}
+
+template <typename T, monoid<T> Monoid>
+T window_aggregate<T, Monoid>::query() const {
+    if (!front_.size()) {
+        return backAgg_;
+    }
+    return monoid_.combine(front_[0].second, backAgg_);
+}
+
+// private
+
+// moves every value of the back stack to the front stack, computing the
+// suffix aggregates from the newest value to the oldest one
+template <typename T, monoid<T> Monoid>
+void window_aggregate<T, Monoid>::flip() {
+    auto agg = monoid_.identity();
+    for (auto i = back_.size(); i != 0; --i) {
+        auto& value = back_[i - 1];
+        agg = monoid_.combine(value, agg);
+        front_.emplace_front(std::move(value), agg);
+    }
+    back_.pop_front(back_.size());
+    backAgg_ = monoid_.identity();
+}
+
+
+
+};
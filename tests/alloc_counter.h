@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "check.h"
+
+// Replaces the global operator new/delete to count live allocations.
+// Include it from one translation unit per test executable only.
+
+inline std::size_t liveAllocations = 0;
+
+void* operator new(std::size_t n) {
+    ++liveAllocations;
+    if (auto p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    if (p) {
+        --liveAllocations;
+        std::free(p);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+// Runs step(i) for i in [0, steps) and checks that the live allocations
+// stop changing after the first warmup steps: a container in a steady state,
+// like a fixed size FIFO, has to reuse its memory instead of growing with the
+// throughput. Returns the settled number of live allocations.
+template <typename Step>
+std::size_t checkAllocationsSettle(Step step, std::size_t steps, std::size_t warmup) {
+    std::size_t warm = 0;
+    for (std::size_t i = 0; i < steps; ++i) {
+        step(i);
+        if (i + 1 == warmup) {
+            warm = liveAllocations;
+        }
+    }
+    KTX_CHECK(liveAllocations == warm);
+    return warm;
+}
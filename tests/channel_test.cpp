@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "ktxchannel.h"
+#include "check.h"
+#include "alloc_counter.h"
+#include "task.h"
+
+
+namespace {
+
+
+
+task produce(ktx::channel<int>& out, int count) {
+    for (int i = 0; i < count; ++i) {
+        bool pushed = co_await out.push(i);
+        KTX_CHECK(pushed);
+    }
+    out.close();
+}
+
+task twice(ktx::channel<int>& in, ktx::channel<int>& out) {
+    while (auto v = co_await in.pop()) {
+        co_await out.push(*v * 2);
+    }
+    out.close();
+}
+
+task collect(ktx::channel<int>& in, std::vector<int>& got, std::size_t batch) {
+    for (;;) {
+        auto values = co_await in.pop_n(batch);
+        if (values.empty()) {
+            break;
+        }
+        KTX_CHECK(values.size() <= batch);
+        got.insert(got.end(), values.begin(), values.end());
+    }
+}
+
+void checkDoubled(const std::vector<int>& got, int count) {
+    KTX_CHECK(got.size() == static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        KTX_CHECK(got[i] == 2 * i);
+    }
+}
+
+void pipelineDeliversInOrder() {
+    for (std::size_t capacity: {std::size_t{1}, std::size_t{2}, std::size_t{7},
+            ktx::channel<int>::unbounded}) {
+        for (bool consumerFirst: {true, false}) {
+            ktx::channel<int> a{capacity};
+            ktx::channel<int> b{capacity};
+            std::vector<int> got;
+
+            if (consumerFirst) {
+                auto c = collect(b, got, 10);
+                auto s = twice(a, b);
+                auto p = produce(a, 5000);
+                KTX_CHECK(c.done() && s.done() && p.done());
+            } else {
+                auto p = produce(a, 5000);
+                auto s = twice(a, b);
+                auto c = collect(b, got, 10);
+                KTX_CHECK(c.done() && s.done() && p.done());
+            }
+            checkDoubled(got, 5000);
+        }
+    }
+}
+
+// a bounded channel drained in batches used to overflow the deque of
+// waiting poppers after a few dozen suspensions
+void batchedBoundedPipeline() {
+    ktx::channel<int> a{1};
+    ktx::channel<int> b{1};
+    std::vector<int> got;
+
+    auto c = collect(b, got, 50);
+    auto s = twice(a, b);
+    auto p = produce(a, 100'000);
+    KTX_CHECK(c.done() && s.done() && p.done());
+    checkDoubled(got, 100'000);
+}
+
+task pushAll(ktx::channel<int>& ch, int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+        co_await ch.push(i);
+    }
+}
+
+task popAll(ktx::channel<int>& ch, std::vector<int>& got, int count) {
+    for (int i = 0; i < count; ++i) {
+        got.push_back(*co_await ch.pop());
+    }
+}
+
+// draining an unbounded channel used to break the next push
+void unboundedReuseAfterDrain() {
+    ktx::channel<int> ch;
+    std::vector<int> got;
+    {
+        auto p = pushAll(ch, 0, 65);
+        auto c = popAll(ch, got, 65);
+        auto q = pushAll(ch, 65, 1);
+        auto d = popAll(ch, got, 1);
+        KTX_CHECK(d.done());
+    }
+    KTX_CHECK(got.size() == 66 && got.back() == 65);
+}
+
+task pushChecked(ktx::channel<int>& ch, int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+        co_await ch.push(i);
+        KTX_CHECK(ch.size() <= ch.capacity());
+    }
+}
+
+task popBatches(ktx::channel<int>& ch, std::vector<int>& got, std::size_t count) {
+    while (got.size() < count) {
+        auto values = co_await ch.pop_n(4);
+        KTX_CHECK(ch.size() <= ch.capacity());
+        got.insert(got.end(), values.begin(), values.end());
+    }
+}
+
+// a batch given back by pop_n used to wake as many pushers as it freed
+// cells, and every woken pusher pushed without looking at the capacity
+void blockedPushersRespectCapacity() {
+    ktx::channel<int> ch{4};
+    std::vector<int> got;
+
+    auto p = pushChecked(ch, 0, 1000);
+    auto q = pushChecked(ch, 1000, 1000);
+    auto r = pushChecked(ch, 2000, 1000);
+    auto c = popBatches(ch, got, 3000);
+    KTX_CHECK(p.done() && q.done() && r.done() && c.done());
+
+    // every producer's values arrive in order
+    int last[3] = {-1, 999, 1999};
+    for (int v: got) {
+        KTX_CHECK(v > last[v / 1000]);
+        last[v / 1000] = v;
+    }
+    KTX_CHECK(got.size() == 3000);
+}
+
+std::string label(int i) {
+    // long enough to live on the heap, so a destroyed batch is caught
+    return "a string past the small buffer #" + std::to_string(i);
+}
+
+task produceLabels(ktx::channel<std::string>& out, int count) {
+    for (int i = 0; i < count; ++i) {
+        co_await out.push(label(i));
+    }
+    out.close();
+}
+
+task forward(ktx::channel<std::string>& in, ktx::channel<std::string>& out) {
+    for (;;) {
+        auto values = co_await in.pop_n(8);
+        if (values.empty()) {
+            break;
+        }
+        for (auto& value: values) {
+            co_await out.push(value);
+        }
+    }
+}
+
+task popLabels(ktx::channel<std::string>& in, std::vector<std::string>& got, int count) {
+    for (int i = 0; i < count; ++i) {
+        got.push_back(*co_await in.pop());
+    }
+}
+
+// a worker suspended in the middle of its batch used to have the batch
+// destroyed by the next push or pop of any other coroutine
+void batchesOutliveOtherOperations() {
+    ktx::channel<std::string> a{16};
+    ktx::channel<std::string> out{1};
+    std::vector<std::string> got;
+
+    auto w1 = forward(a, out);
+    auto w2 = forward(a, out);
+    auto p = produceLabels(a, 5000);
+    auto c = popLabels(out, got, 5000);
+    KTX_CHECK(w1.done() && w2.done() && p.done() && c.done());
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 5000; ++i) {
+        expected.push_back(label(i));
+    }
+    std::sort(got.begin(), got.end());
+    std::sort(expected.begin(), expected.end());
+    KTX_CHECK(got == expected);
+    KTX_CHECK(a.size() == 0 && out.size() == 0);
+}
+
+task closeEarly(ktx::channel<int>& ch, bool& rejected) {
+    co_await ch.push(1);
+    ch.close();
+    rejected = !co_await ch.push(2);
+}
+
+task drain(ktx::channel<int>& ch, std::vector<int>& got, bool& ended) {
+    while (auto v = co_await ch.pop()) {
+        got.push_back(*v);
+    }
+    ended = true;
+}
+
+void closeRejectsPushesAndEndsPops() {
+    ktx::channel<int> ch{4};
+    std::vector<int> got;
+    bool rejected = false;
+    bool ended = false;
+
+    auto p = closeEarly(ch, rejected);
+    auto c = drain(ch, got, ended);
+    KTX_CHECK(rejected && ended);
+    KTX_CHECK(got.size() == 1 && got[0] == 1);
+}
+
+task countAllocations(ktx::channel<int>& in, std::size_t& warm, std::size_t& last) {
+    std::size_t seen = 0;
+    while (auto v = co_await in.pop()) {
+        if (++seen == 100'000) {
+            warm = liveAllocations;
+        }
+        last = liveAllocations;
+    }
+}
+
+// a long running channel has to reuse the blocks of its buffer
+void memoryIsBounded() {
+    ktx::channel<int> ch{16};
+    std::size_t warm = 0;
+    std::size_t last = 0;
+
+    auto c = countAllocations(ch, warm, last);
+    auto p = produce(ch, 1'000'000);
+    KTX_CHECK(c.done() && warm == last);
+}
+
+
+
+}
+
+int main() {
+    pipelineDeliversInOrder();
+    batchedBoundedPipeline();
+    unboundedReuseAfterDrain();
+    blockedPushersRespectCapacity();
+    batchesOutliveOtherOperations();
+    closeRejectsPushesAndEndsPops();
+    memoryIsBounded();
+}
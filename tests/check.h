@@ -0,0 +1,14 @@
+#pragma once
+
+
+#include <cstdlib>
+#include <iostream>
+
+#define KTX_CHECK(cond)                                                     \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::cerr << __FILE__ << ':' << __LINE__                        \
+                      << ": check failed: " #cond "\n";                     \
+            std::exit(EXIT_FAILURE);                                        \
+        }                                                                   \
+    } while (false)
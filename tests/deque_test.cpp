@@ -0,0 +1,265 @@
+#include <array>
+#include <deque>
+#include <random>
+#include <vector>
+#include "ktxdeque.h"
+#include "check.h"
+#include "alloc_counter.h"
+
+
+namespace {
+
+
+
+template <typename T>
+void checkEqual(const ktx::deque<T>& d, const std::deque<T>& ref) {
+    KTX_CHECK(d.size() == ref.size());
+    for (std::size_t i = 0; i < ref.size(); ++i) {
+        KTX_CHECK(d[i] == ref[i]);
+    }
+}
+
+// draining a deque whose last element sits in the last cell of the map
+// used to leave ai_ past the map, the next push wrote out of bounds
+void drainedDequeIsReusable() {
+    for (int n = 1; n < 600; ++n) {
+        ktx::deque<int> bulk;
+        ktx::deque<int> single;
+        ktx::deque<int> back;
+        for (int i = 0; i < n; ++i) {
+            bulk.push_back(i);
+            single.push_back(i);
+            back.push_front(i);
+        }
+        bulk.pop_front(n);
+        for (int i = 0; i < n; ++i) {
+            single.pop_front();
+            back.pop_back();
+        }
+
+        bulk.push_back(100);
+        single.push_back(100);
+        back.push_front(100);
+        KTX_CHECK(bulk.size() == 1 && bulk[0] == 100);
+        KTX_CHECK(single.size() == 1 && single[0] == 100);
+        KTX_CHECK(back.size() == 1 && back[0] == 100);
+    }
+
+    // elements wider than half a chunk get one cell per block, the first
+    // push_front used to construct before the first block
+    struct big {
+        char bytes[304];
+        int value;
+    };
+    for (int n = 0; n < 8; ++n) {
+        ktx::deque<big> front;
+        ktx::deque<big> back;
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i <= n; ++i) {
+                front.push_front(big{{}, i});
+                back.push_back(big{{}, i});
+            }
+            KTX_CHECK(front.size() == std::size_t(n) + 1);
+            KTX_CHECK(front[0].value == n && front[n].value == 0);
+            KTX_CHECK(back[0].value == 0 && back[n].value == n);
+            for (int i = 0; i <= n; ++i) {
+                front.pop_back();
+                back.pop_front();
+            }
+            KTX_CHECK(front.empty() && back.empty());
+        }
+    }
+}
+
+void fifoMemoryIsBounded() {
+    const auto before = liveAllocations;
+    for (bool atFront: {false, true}) {
+        ktx::deque<int> d;
+        for (int i = 0; i < 1000; ++i) {
+            atFront ? d.push_front(i) : d.push_back(i);
+        }
+
+        auto settled = checkAllocationsSettle([&](std::size_t step) {
+            int i = 1000 + static_cast<int>(step);
+            if (atFront) {
+                d.push_front(i);
+                d.pop_back();
+            } else {
+                d.push_back(i);
+                d.pop_front();
+            }
+        }, 1'999'000, 100'000);
+        // the map and a handful of blocks around the 1000 elements
+        KTX_CHECK(settled - before < 64);
+        KTX_CHECK(d.size() == 1000);
+        for (int i = 0; i < 1000; ++i) {
+            KTX_CHECK(d[i] == (atFront ? 1'999'999 - i : 1'999'000 + i));
+        }
+    }
+    KTX_CHECK(liveAllocations == before);
+}
+
+void randomOperationsMatchStd() {
+    std::mt19937 gen{42};
+    ktx::deque<int> d;
+    std::deque<int> ref;
+
+    for (int step = 0; step < 200'000; ++step) {
+        auto op = gen() % 10;
+        int value = static_cast<int>(gen() % 1000);
+        if (op < 3) {
+            d.push_back(value);
+            ref.push_back(value);
+        } else if (op < 6) {
+            d.push_front(value);
+            ref.push_front(value);
+        } else if (op < 8 && ref.size()) {
+            d.pop_back();
+            ref.pop_back();
+        } else if (op < 9 && ref.size()) {
+            d.pop_front();
+            ref.pop_front();
+        } else {
+            auto count = std::min<std::size_t>(gen() % 300, ref.size());
+            d.pop_front(count);
+            ref.erase(ref.begin(), ref.begin() + count);
+        }
+        if (step % 1000 == 0) {
+            checkEqual(d, ref);
+        }
+    }
+    checkEqual(d, ref);
+}
+
+// lookup tables built by a deque at compile time and flattened into arrays
+constexpr auto squares = [] {
+    ktx::deque<int> d;
+    for (int i = 0; i < 300; ++i) {
+        d.push_back(i * i);
+    }
+    for (int i = 1; i <= 200; ++i) {
+        d.push_front(-i);
+    }
+    d.pop_back();
+    d.pop_front();
+    d.pop_front(49);
+
+    ktx::deque<int> copy = d;
+    std::array<int, 449> table{};
+    std::size_t i = 0;
+    for (int x: copy) {
+        table[i++] = x;
+    }
+    return table;
+}();
+
+static_assert(squares[0] == -150 && squares[149] == -1);
+static_assert(squares[150] == 0 && squares[448] == 298 * 298);
+
+// a compile time FIFO goes through the block recycling path as well
+constexpr long long fifoSum = [] {
+    ktx::deque<long long> d{1, 2, 3};
+    for (long long i = 4; i < 5000; ++i) {
+        d.push_back(i);
+        d.pop_front();
+    }
+    long long sum = 0;
+    for (auto x: d) {
+        sum += x;
+    }
+    return sum;
+}();
+
+static_assert(fifoSum == 4997 + 4998 + 4999);
+
+constexpr int filled = [] {
+    ktx::deque<int> d(1000, 7);
+    int sum = 0;
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        sum += d[i];
+    }
+    return sum;
+}();
+
+static_assert(filled == 7000);
+
+template <typename D, typename It>
+concept can_stream_copy = requires (D d, It it) { d.stream_copy(it, it, d.begin()); };
+
+static_assert(can_stream_copy<ktx::deque<double>, std::vector<double>::iterator>);
+static_assert(can_stream_copy<ktx::deque<double>, const double*>);
+static_assert(!can_stream_copy<ktx::deque<double>, std::vector<int>::iterator>);
+static_assert(!can_stream_copy<ktx::deque<std::vector<int>>, std::vector<int>*>);
+
+void prefetchedTraversalVisitsAll() {
+    ktx::deque<int> d;
+    for (int i = 0; i < 5000; ++i) {
+        d.push_back(i);
+    }
+    for (int i = 1; i < 700; ++i) {
+        d.push_front(-i);
+    }
+
+    for (std::size_t distance: {0, 1, 2, 100}) {
+        for (std::size_t lines: {0, 1, 2, 1000}) {
+            int expected = -699;
+            const auto& cd = d;
+            cd.for_each_prefetched([&expected](const int& x) {
+                KTX_CHECK(x == expected);
+                ++expected;
+            }, distance, lines);
+            KTX_CHECK(expected == 5000);
+        }
+    }
+
+    d.for_each_prefetched([](int& x) { x *= 2; });
+    for (int i = 0; i < 5699; ++i) {
+        KTX_CHECK(d[i] == 2 * (i - 699));
+    }
+
+    ktx::deque<int> empty;
+    empty.for_each_prefetched([](int) { KTX_CHECK(false); });
+}
+
+void streamingWritesLandInPlace() {
+    ktx::deque<double> d(3000, 1.0);
+    std::vector<double> source(2500);
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<double>(i);
+    }
+
+    // odd offsets make the destinations start off the 16 byte boundary
+    auto end = d.stream_copy(source.begin() + 1, source.end(), d.begin() + 101);
+    KTX_CHECK(end == d.begin() + 101 + 2499);
+    d.stream_fill(d.begin() + 2700, d.end(), 3.0);
+
+    for (std::size_t i = 0; i < d.size(); ++i) {
+        double expected = i < 101 ? 1.0
+            : i < 2600 ? static_cast<double>(i - 100)
+            : i < 2700 ? 1.0
+            : 3.0;
+        KTX_CHECK(d[i] == expected);
+    }
+
+    struct rgb {
+        char r, g, b;
+    };
+    ktx::deque<rgb> pixels(1000, rgb{0, 0, 0});
+    pixels.stream_fill(pixels.begin() + 3, pixels.end() - 3, rgb{1, 2, 3});
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        bool filled = i >= 3 && i < 997;
+        KTX_CHECK(pixels[i].r == (filled ? 1 : 0) && pixels[i].b == (filled ? 3 : 0));
+    }
+}
+
+
+
+}
+
+int main() {
+    drainedDequeIsReusable();
+    fifoMemoryIsBounded();
+    randomOperationsMatchStd();
+    prefetchedTraversalVisitsAll();
+    streamingWritesLandInPlace();
+}
@@ -0,0 +1,127 @@
+#include <deque>
+#include <random>
+#include <string>
+#include <tuple>
+#include "ktxsoadeque.h"
+#include "check.h"
+#include "alloc_counter.h"
+
+
+namespace {
+
+
+
+using row = std::tuple<double, int, std::string>;
+
+void checkEqual(const ktx::soa_deque<double, int, std::string>& d,
+        const std::deque<row>& ref) {
+    KTX_CHECK(d.size() == ref.size());
+    std::size_t i = 0;
+    for (auto [price, volume, name]: d) {
+        KTX_CHECK(price == std::get<0>(ref[i]));
+        KTX_CHECK(volume == std::get<1>(ref[i]));
+        KTX_CHECK(name == std::get<2>(ref[i]));
+        KTX_CHECK(d.get<1>(i) == volume);
+        ++i;
+    }
+
+    // every field's segments cover the same rows in the same order
+    std::size_t seen = 0;
+    for (auto segment: d.segments<0>()) {
+        for (double price: segment) {
+            KTX_CHECK(price == std::get<0>(ref[seen]));
+            ++seen;
+        }
+    }
+    KTX_CHECK(seen == ref.size());
+}
+
+void rowsMatchStd() {
+    std::mt19937 gen{3};
+    ktx::soa_deque<double, int, std::string> d;
+    std::deque<row> ref;
+
+    for (int step = 0; step < 50'000; ++step) {
+        auto op = gen() % 8;
+        int v = static_cast<int>(gen() % 10'000);
+        if (op < 3) {
+            d.push_back(v * 0.5, v, std::to_string(v));
+            ref.emplace_back(v * 0.5, v, std::to_string(v));
+        } else if (op < 5) {
+            d.push_front(v * 0.5, v, std::to_string(v));
+            ref.emplace_front(v * 0.5, v, std::to_string(v));
+        } else if (op < 7 && ref.size()) {
+            d.pop_front();
+            ref.pop_front();
+        } else if (ref.size()) {
+            d.pop_back();
+            ref.pop_back();
+        }
+        if (step % 2000 == 0) {
+            checkEqual(d, ref);
+            auto copy = d;
+            checkEqual(copy, ref);
+        }
+    }
+    checkEqual(d, ref);
+}
+
+void proxiesWriteThrough() {
+    ktx::soa_deque<int, char> d;
+    for (int i = 0; i < 1000; ++i) {
+        d.push_back(i, 'a');
+    }
+    for (auto [value, tag]: d) {
+        value *= 2;
+        tag = 'b';
+    }
+    std::get<0>(d[10]) = -1;
+
+    long long sum = 0;
+    for (auto segment: d.segments<0>()) {
+        for (int x: segment) {
+            sum += x;
+        }
+    }
+    KTX_CHECK(sum == 999 * 1000 - 20 - 1);
+    KTX_CHECK(d.get<1>(999) == 'b');
+
+    auto it = d.cbegin() + 500;
+    KTX_CHECK(std::get<0>(it[1]) == 1002 && d.cend() - it == 500);
+}
+
+void fifoMemoryIsBounded() {
+    for (bool atFront: {false, true}) {
+        ktx::soa_deque<int, double> d;
+        for (int i = 0; i < 1000; ++i) {
+            atFront ? d.push_front(i, i) : d.push_back(i, i);
+        }
+
+        checkAllocationsSettle([&](std::size_t step) {
+            int i = 1000 + static_cast<int>(step);
+            if (atFront) {
+                d.push_front(i, i);
+                d.pop_back();
+            } else {
+                d.push_back(i, i);
+                d.pop_front();
+            }
+        }, 999'000, 100'000);
+        KTX_CHECK(d.size() == 1000);
+
+        for (int i = 0; i < 1000; ++i) {
+            d.pop_front();
+        }
+        d.push_back(7, 7.0);
+        KTX_CHECK(d.size() == 1 && d.get<0>(0) == 7);
+    }
+}
+
+
+}
+
+int main() {
+    rowsMatchStd();
+    proxiesWriteThrough();
+    fifoMemoryIsBounded();
+}
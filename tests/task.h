@@ -0,0 +1,37 @@
+#pragma once
+
+
+#include <coroutine>
+#include <exception>
+
+// Eagerly started coroutine that stays suspended at the end until the
+// task object is destroyed, enough to drive channels on one thread.
+struct task {
+    struct promise_type {
+        task get_return_object() {
+            return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit task(std::coroutine_handle<promise_type> h) : h_{h} {}
+
+    task(task&& other) noexcept : h_{other.h_} { other.h_ = {}; }
+
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    ~task() {
+        if (h_) {
+            h_.destroy();
+        }
+    }
+
+    bool done() const { return h_.done(); }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+};
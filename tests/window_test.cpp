@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <random>
+#include "ktxwindow.h"
+#include "check.h"
+
+
+namespace {
+
+
+
+struct tick {
+    long long time;
+    int price;
+};
+
+struct tick_sum {
+    static tick identity() { return {0, 0}; }
+    static tick combine(const tick& a, const tick& b) {
+        return {std::max(a.time, b.time), a.price + b.price};
+    }
+};
+
+// evicting the element in the last cell of the block map used to crash
+// the next push
+void reuseAfterDrain() {
+    ktx::window_aggregate<int> w;
+    for (int i = 0; i < 65; ++i) {
+        w.push(i);
+    }
+    w.evict(1);
+    w.push(100);
+    KTX_CHECK(w.size() == 65);
+    KTX_CHECK(w.query() == 64 * 65 / 2 + 100);
+
+    ktx::monotonic_window<int> m;
+    for (int n = 1; n < 300; ++n) {
+        for (int i = 0; i < n; ++i) {
+            m.push(i);
+        }
+        m.evict(n);
+        m.push(-1);
+        KTX_CHECK(m.size() == 1 && m.top() == -1);
+        m.evict();
+    }
+}
+
+void matchesNaiveRecomputation() {
+    std::mt19937 gen{7};
+    ktx::monotonic_window<int> maxWindow;
+    ktx::monotonic_window<int, std::greater<int>> minWindow;
+    ktx::window_aggregate<long long> sum;
+    ktx::window_aggregate<int, ktx::min_monoid<int>> min;
+    ktx::window_aggregate<int, ktx::max_monoid<int>> max;
+    std::deque<int> ref;
+
+    for (int step = 0; step < 20'000; ++step) {
+        if (gen() % 3 || ref.empty()) {
+            int v = static_cast<int>(gen() % 1000);
+            ref.push_back(v);
+            maxWindow.push(v);
+            minWindow.push(v);
+            sum.push(v);
+            min.push(v);
+            max.push(v);
+        } else {
+            auto k = std::min<std::size_t>(gen() % 6, ref.size());
+            ref.erase(ref.begin(), ref.begin() + k);
+            maxWindow.evict(k);
+            minWindow.evict(k);
+            sum.evict(k);
+            min.evict(k);
+            max.evict(k);
+        }
+
+        KTX_CHECK(sum.size() == ref.size() && maxWindow.size() == ref.size());
+        KTX_CHECK(sum.query() == std::accumulate(ref.begin(), ref.end(), 0LL));
+        if (ref.size()) {
+            auto [lo, hi] = std::minmax_element(ref.begin(), ref.end());
+            KTX_CHECK(maxWindow.top() == *hi && max.query() == *hi);
+            KTX_CHECK(minWindow.top() == *lo && min.query() == *lo);
+            KTX_CHECK(sum.oldest() == ref.front());
+        }
+    }
+}
+
+void timeBasedEviction() {
+    ktx::window_aggregate<tick, tick_sum> w;
+    std::deque<tick> ref;
+
+    for (long long t = 0; t < 50'000; ++t) {
+        w.push({t, static_cast<int>(t % 97)});
+        ref.push_back({t, static_cast<int>(t % 97)});
+
+        auto cutoff = t - 1000 + static_cast<long long>(t % 13);
+        w.evict_while([cutoff](const tick& x) { return x.time < cutoff; });
+        while (ref.size() && ref.front().time < cutoff) {
+            ref.pop_front();
+        }
+
+        KTX_CHECK(w.size() == ref.size());
+        int expected = 0;
+        for (auto& x: ref) {
+            expected += x.price;
+        }
+        KTX_CHECK(w.query().price == expected);
+    }
+}
+
+
+
+}
+
+int main() {
+    reuseAfterDrain();
+    matchesNaiveRecomputation();
+    timeBasedEviction();
+}